@@ -4,82 +4,121 @@
  *   Run time error
  * AUTHOR: Blaise Barney  01/09/04
  * LAST REVISED: 06/28/05
+ *
+ *   The two sections are generalized to a list of independent vector kernels.
+ *   Every kernel runs as its own task and formats its results into its own
+ *   buffer, the buffers are printed once all tasks are done.
  ******************************************************************************/
 #include <omp.h>
 #include <stdio.h>
 #include <stdlib.h>
 #define N     50
+#define VALUES_PER_LINE 5
+// "Thread %d did kernel %d (%s). The results are:" plus N formatted floats
+#define OUTPUT_SIZE (128 + N * 16)
 
-int main(int argc, char *argv[]) {
-	int i, nthreads, tid, section;
-	float a[N], b[N], c[N];
-	void print_results(float array[N], int tid, int section);
+typedef void (*vectorKernel)(const float *a, const float *b, float *c, int n);
 
-	/* Some initializations */
-	for (i = 0; i < N; i++)
-		a[i] = b[i] = i * 1.0;
+struct kernel {
+	const char *name;
+	vectorKernel run;
+	int tid;
+	float c[N];
+	char output[OUTPUT_SIZE];
+	int outputLength;
+};
+typedef struct kernel kernel;
 
-	// c war nicht private und hat sich daher gegenseitig überschrieben
-#pragma omp parallel private(i,tid,section, c) num_threads(2)
-	{
-		tid = omp_get_thread_num();
-		if (tid == 0) {
-			nthreads = omp_get_num_threads();
-			printf("Number of threads = %d\n", nthreads);
-		}
+void multiply(const float *a, const float *b, float *c, int n) {
+#pragma omp simd
+	for (int i = 0; i < n; i++)
+		c[i] = a[i] * b[i];
+}
 
-		/*** Use barriers for clean output ***/
-#pragma omp barrier
-		printf("Thread %d starting...\n", tid);
-#pragma omp barrier
+void add(const float *a, const float *b, float *c, int n) {
+#pragma omp simd
+	for (int i = 0; i < n; i++)
+		c[i] = a[i] + b[i];
+}
 
-#pragma omp sections nowait
-		{
-#pragma omp section
-			{
-				section = 1;
-				for (i = 0; i < N; i++)
-					c[i] = a[i] * b[i];
-				print_results(c, tid, section);
-			}
+void subtract(const float *a, const float *b, float *c, int n) {
+#pragma omp simd
+	for (int i = 0; i < n; i++)
+		c[i] = a[i] - b[i];
+}
 
-#pragma omp section
-			{
-				section = 2;
-				for (i = 0; i < N; i++)
-					c[i] = a[i] + b[i];
-				print_results(c, tid, section);
-			}
-		} /* end of sections */
+void multiplyAdd(const float *a, const float *b, float *c, int n) {
+#pragma omp simd
+	for (int i = 0; i < n; i++)
+		c[i] = a[i] * b[i] + a[i];
+}
 
-		/*** Use barrier for clean output ***/
-#pragma omp barrier
-		printf("Thread %d exiting...\n", tid);
+void square(const float *a, const float *b, float *c, int n) {
+#pragma omp simd
+	for (int i = 0; i < n; i++)
+		c[i] = a[i] * a[i];
+}
 
-	} /* end of parallel section */
+void maximum(const float *a, const float *b, float *c, int n) {
+#pragma omp simd
+	for (int i = 0; i < n; i++)
+		c[i] = a[i] > b[i] ? a[i] : b[i];
 }
 
-void print_results(float array[N], int tid, int section) {
-	int i, j;
+// same format as the old print_results, but into the kernel's own buffer,
+// formatting stops once the buffer is full
+void formatResults(kernel *k, int id) {
+	int length = snprintf(k->output, OUTPUT_SIZE,
+			"\nThread %d did kernel %d (%s). The results are:\n", k->tid, id,
+			k->name);
+	for (int i = 0; i < N && length < OUTPUT_SIZE; i++) {
+		length += snprintf(k->output + length, OUTPUT_SIZE - length, "%e  ",
+				k->c[i]);
+		if ((i + 1) % VALUES_PER_LINE == 0 && length < OUTPUT_SIZE)
+			length += snprintf(k->output + length, OUTPUT_SIZE - length, "\n");
+	}
+	if (length < OUTPUT_SIZE)
+		length += snprintf(k->output + length, OUTPUT_SIZE - length, "\n");
+	k->outputLength = length < OUTPUT_SIZE ? length : OUTPUT_SIZE - 1;
+}
 
-	j = 1;
-	/*** use critical for clean output ***/
-#pragma omp critical
+void runKernels(kernel *kernels, int count, const float *a, const float *b) {
+#pragma omp parallel
+#pragma omp single
 	{
-		printf("\nThread %d did section %d. The results are:\n", tid, section);
-		for (i = 0; i < N; i++) {
-			printf("%e  ", array[i]);
-			j++;
-			if (j == 6) {
-				printf("\n");
-				j = 1;
+		for (int id = 0; id < count; id++) {
+			// the tasks go to the team's task queue, with gcc's libgomp one
+			// shared queue without work stealing, and idle threads of the
+			// team take the remaining kernels from it
+#pragma omp task firstprivate(id)
+			{
+				kernel *k = &kernels[id];
+				k->tid = omp_get_thread_num();
+				k->run(a, b, k->c, N);
+				formatResults(k, id);
 			}
 		}
-		printf("\n");
-	} /*** end of critical ***/
+	}
+}
+
+int main(int argc, char *argv[]) {
+	float a[N], b[N];
+	kernel kernels[] = { { "a*b", multiply }, { "a+b", add }, { "a-b",
+			subtract }, { "a*b+a", multiplyAdd }, { "a*a", square }, {
+			"max(a,b)", maximum } };
+	int count = sizeof(kernels) / sizeof(kernels[0]);
+
+	/* Some initializations */
+	for (int i = 0; i < N; i++)
+		a[i] = b[i] = i * 1.0;
 
-//#pragma omp barrier
-	printf("Thread %d done and synchronized.\n", tid);
+	printf("Number of threads = %d\n", omp_get_max_threads());
 
-}
+	runKernels(kernels, count, a, b);
 
+	/*** one writer after all kernels are done, no critical needed ***/
+	for (int id = 0; id < count; id++) {
+		fwrite(kernels[id].output, 1, kernels[id].outputLength, stdout);
+	}
+	return EXIT_SUCCESS;
+}
@@ -5,6 +5,10 @@
  *   it to the other's array, however a deadlock occurs.
  * AUTHOR: Blaise Barney  01/29/04
  * LAST REVISED: 04/06/05
+ *
+ *   The fixed sections version only keeps two threads busy. It is benchmarked
+ *   against two lock free versions, one data parallel and one task graph.
+ *   All of them initialize a and b, then add a to b and finally b to a.
  ******************************************************************************/
 #include <omp.h>
 #include <stdio.h>
@@ -12,42 +16,31 @@
 #define N 1000000
 #define PI 3.1415926535
 #define DELTA .01415926535
+#define BLOCK 16384
+#define RUNS 20
 
-int main(int argc, char *argv[]) {
-	int nthreads, tid, i;
-	float a[N], b[N];
+// too large for the stack of main
+static float a[N], b[N];
+
+void combineWithLocks(void) {
 	omp_lock_t locka, lockb;
 
 	/* Initialize the locks */
 	omp_init_lock(&locka);
 	omp_init_lock(&lockb);
 
-	/* Fork a team of threads giving them their own copies of variables */
-#pragma omp parallel shared(a, b, nthreads, locka, lockb) private(tid)
+#pragma omp parallel shared(a, b, locka, lockb)
 	{
-
-		/* Obtain thread number and number of threads */
-		tid = omp_get_thread_num();
-#pragma omp master
-		{
-			nthreads = omp_get_num_threads();
-			printf("Number of threads = %d\n", nthreads);
-		}
-		printf("Thread %d starting...\n", tid);
-#pragma omp barrier
-
 #pragma omp sections nowait
 		{
 #pragma omp section
 			{
-				printf("Thread %d initializing a[]\n", tid);
 				omp_set_lock(&locka);
-				for (i = 0; i < N; i++)
+				for (int i = 0; i < N; i++)
 					a[i] = i * DELTA;
 				omp_unset_lock(&locka);
 				omp_set_lock(&lockb);
-				printf("Thread %d adding a[] to b[]\n", tid);
-				for (i = 0; i < N; i++)
+				for (int i = 0; i < N; i++)
 					b[i] += a[i];
 				omp_unset_lock(&lockb);
 				// lock freigeben, bevor das nächste gelocked wird
@@ -55,14 +48,12 @@ int main(int argc, char *argv[]) {
 
 #pragma omp section
 			{
-				printf("Thread %d initializing b[]\n", tid);
 				omp_set_lock(&lockb);
-				for (i = 0; i < N; i++)
+				for (int i = 0; i < N; i++)
 					b[i] = i * PI;
 				omp_unset_lock(&lockb);
 				omp_set_lock(&locka);
-				printf("Thread %d adding b[] to a[]\n", tid);
-				for (i = 0; i < N; i++)
+				for (int i = 0; i < N; i++)
 					a[i] += b[i];
 				omp_unset_lock(&locka);
 				// lock freigeben, bevor das nächste gelocked wird
@@ -70,5 +61,101 @@ int main(int argc, char *argv[]) {
 		} /* end of sections */
 	} /* end of parallel region */
 
+	omp_destroy_lock(&locka);
+	omp_destroy_lock(&lockb);
+}
+
+void combineParallelFor(void) {
+#pragma omp parallel
+	{
+		// same static schedule in both loops, so each thread only touches
+		// the elements it initialized itself and nowait is safe
+#pragma omp for simd schedule(static) nowait
+		for (int i = 0; i < N; i++) {
+			a[i] = i * DELTA;
+			b[i] = i * PI;
+		}
+
+#pragma omp for simd schedule(static)
+		for (int i = 0; i < N; i++) {
+			b[i] += a[i];
+			a[i] += b[i];
+		}
+	}
 }
 
+void combineTasks(void) {
+#pragma omp parallel
+#pragma omp single
+	{
+		// the first element stands for the whole block in the dependencies
+		for (int start = 0; start < N; start += BLOCK) {
+			int end = start + BLOCK < N ? start + BLOCK : N;
+
+#pragma omp task depend(out: a[start])
+#pragma omp simd
+			for (int i = start; i < end; i++)
+				a[i] = i * DELTA;
+
+#pragma omp task depend(out: b[start])
+#pragma omp simd
+			for (int i = start; i < end; i++)
+				b[i] = i * PI;
+
+#pragma omp task depend(in: a[start]) depend(inout: b[start])
+#pragma omp simd
+			for (int i = start; i < end; i++)
+				b[i] += a[i];
+
+#pragma omp task depend(in: b[start]) depend(inout: a[start])
+#pragma omp simd
+			for (int i = start; i < end; i++)
+				a[i] += b[i];
+		}
+	}
+}
+
+int checkResult(const char *name) {
+	for (int i = 0; i < N; i++) {
+		float expectedA = i * DELTA;
+		float expectedB = i * PI;
+		expectedB += expectedA;
+		expectedA += expectedB;
+		if (a[i] != expectedA || b[i] != expectedB) {
+			printf("%s: wrong result at %d: a=%e b=%e\n", name, i, a[i], b[i]);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+double measure(void (*combine)(void)) {
+	// first run warms up the thread pool and the pages of a and b
+	combine();
+	double start = omp_get_wtime();
+	for (int run = 0; run < RUNS; run++) {
+		combine();
+	}
+	return (omp_get_wtime() - start) / RUNS;
+}
+
+int main(int argc, char *argv[]) {
+	printf("Number of threads = %d\n", omp_get_max_threads());
+
+	// the sections version adds to arrays the other section may not have
+	// initialized yet, so its result is not checked
+	double locks = measure(combineWithLocks);
+	printf("sections with locks: %fms\n", locks * 1E3);
+
+	double parallelFor = measure(combineParallelFor);
+	int correct = checkResult("parallel for simd");
+	printf("parallel for simd:   %fms, speedup %.2f\n", parallelFor * 1E3,
+			locks / parallelFor);
+
+	double tasks = measure(combineTasks);
+	correct = checkResult("task graph") && correct;
+	printf("task graph:          %fms, speedup %.2f\n", tasks * 1E3,
+			locks / tasks);
+
+	return correct ? EXIT_SUCCESS : EXIT_FAILURE;
+}
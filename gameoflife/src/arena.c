@@ -0,0 +1,63 @@
+#include <sys/mman.h>
+#include "arena.h"
+
+static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+static const size_t ALIGNMENT = 64;
+
+static long allocations = 0;
+
+void countAllocation(void) {
+#pragma omp atomic
+	allocations++;
+}
+
+long allocationCount(void) {
+	long count;
+#pragma omp atomic read
+	count = allocations;
+	return count;
+}
+
+int initArena(arena *a, size_t capacity) {
+	capacity = (capacity + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+	a->used = 0;
+	a->capacity = capacity;
+
+	// explicit huge pages are only available if the admin reserved some,
+	// they must not be MAP_NORESERVE or touching them may raise SIGBUS
+	a->base = mmap(NULL, capacity, PROT_READ | PROT_WRITE,
+	MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	if (a->base == MAP_FAILED) {
+		a->base = mmap(NULL, capacity, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		if (a->base == MAP_FAILED) {
+			a->base = NULL;
+			a->capacity = 0;
+			return -1;
+		}
+		// fall back to transparent huge pages
+		madvise(a->base, capacity, MADV_HUGEPAGE);
+	}
+	countAllocation();
+	return 0;
+}
+
+void freeArena(arena *a) {
+	if (a->base)
+		munmap(a->base, a->capacity);
+	a->base = NULL;
+	a->capacity = 0;
+	a->used = 0;
+}
+
+void resetArena(arena *a) {
+	a->used = 0;
+}
+
+void* arenaAlloc(arena *a, size_t size) {
+	size_t start = (a->used + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+	if (start + size > a->capacity)
+		return NULL;
+	a->used = start + size;
+	return a->base + start;
+}
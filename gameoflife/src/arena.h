@@ -0,0 +1,30 @@
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <stddef.h>
+
+/*
+ * Bump allocator on top of a single mapping. The mapping is reserved once and
+ * backed by huge pages where the system allows it, so allocating from an
+ * arena never reaches the system allocator again. resetArena makes the whole
+ * arena reusable, e.g. for the next generation.
+ */
+struct arena {
+	char *base;
+	size_t capacity;
+	size_t used;
+};
+typedef struct arena arena;
+
+int initArena(arena *a, size_t capacity);
+void freeArena(arena *a);
+void resetArena(arena *a);
+
+// returns memory aligned to a cache line, or NULL if the arena is exhausted
+void* arenaAlloc(arena *a, size_t size);
+
+// number of calls into the system allocator since program start
+void countAllocation(void);
+long allocationCount(void);
+
+#endif /* ARENA_H_ */
@@ -0,0 +1,37 @@
+#ifndef BITLIFE_H_
+#define BITLIFE_H_
+
+#include <stdint.h>
+
+/*
+ * Game of life on 64 cells at once. Bit i of a word is one cell, the west and
+ * east words hold the left and right neighbour of cell i at bit i.
+ */
+
+// bit sliced counter, s2 saturates once four or more neighbours were added
+static inline void addNeighbours(uint64_t n, uint64_t *s0, uint64_t *s1,
+		uint64_t *s2) {
+	uint64_t carry0 = *s0 & n;
+	*s0 ^= n;
+	uint64_t carry1 = *s1 & carry0;
+	*s1 ^= carry0;
+	*s2 |= carry1;
+}
+
+static inline uint64_t evolveWord(uint64_t aboveWest, uint64_t above,
+		uint64_t aboveEast, uint64_t west, uint64_t centre, uint64_t east,
+		uint64_t belowWest, uint64_t below, uint64_t belowEast) {
+	uint64_t s0 = 0, s1 = 0, s2 = 0;
+	addNeighbours(aboveWest, &s0, &s1, &s2);
+	addNeighbours(above, &s0, &s1, &s2);
+	addNeighbours(aboveEast, &s0, &s1, &s2);
+	addNeighbours(west, &s0, &s1, &s2);
+	addNeighbours(east, &s0, &s1, &s2);
+	addNeighbours(belowWest, &s0, &s1, &s2);
+	addNeighbours(below, &s0, &s1, &s2);
+	addNeighbours(belowEast, &s0, &s1, &s2);
+	// alive with three neighbours, or with two if alive before
+	return ~s2 & s1 & (s0 | centre);
+}
+
+#endif /* BITLIFE_H_ */
@@ -1,14 +1,30 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
 #include <omp.h>
 #include <time.h>
-
-static const int sizeX = 30;
-static const int sizeY = 30;
-static const int CHUNKS_X = 3;
-static const int CHUNKS_Y = 3;
+#include <unistd.h>
+#include "arena.h"
+#include "mapped.h"
+#include "snapshot.h"
+#include "sparse.h"
+
+// the dense engine defaults, "gameoflife dense" overrides them for benchmarks
+static int sizeX = 30;
+static int sizeY = 30;
+static int CHUNKS_X = 3;
+static int CHUNKS_Y = 3;
+static int RUNS_PER_THREAD = 100;
+static int writeOutput = 1;
 static const int INT_SIZE = 32;
-static const int RUNS_PER_THREAD = 100;
+// bytes of one board processed per band in the memory mapped mode
+static const size_t MAPPED_BAND_BYTES = 64 * 1024 * 1024;
+// room for the xml around the raw cell data of one output file
+static const int SNAPSHOT_HEADER_SIZE = 4096;
+// time spent in cycle, without setup and output
+static double kernelNanos = 0;
 
 typedef unsigned int bitvector;
 
@@ -140,78 +156,96 @@ void cycleSubdomain(domain d, bitvector *fieldVector,
 	}
 }
 
-void writePVTK(int cycleNum, char prefix[1024], domain* domains) {
+int writePVTK(int cycleNum, const char *prefix, domain* domains, arena *scratch) {
 
 	char filename[2048];
 
 	snprintf(filename, sizeof(filename), "%s%s%d%s", prefix,"step",cycleNum, ".pvti");
-	FILE* fp = fopen(filename, "w");
+	snapshot s;
+	initSnapshot(&s, scratch, SNAPSHOT_HEADER_SIZE * (CHUNKS_X * CHUNKS_Y + 1));
 
-	fprintf(fp, "<?xml version=\"1.0\"?>\n");
-	fprintf(fp,
+	snapshotPrintf(&s, "<?xml version=\"1.0\"?>\n");
+	snapshotPrintf(&s,
 			"<VTKFile type=\"PImageData\" version=\"0.1\" byte_order=\"LittleEndian\" >\n");
-	fprintf(fp,
+	snapshotPrintf(&s,
 			"<PImageData WholeExtent=\"%d %d %d %d %d %d\" Origin=\"0 0 0\" Spacing=\"%le %le %le\">\n",
 			0, sizeX, 0, sizeY, 0, 0, 1.0, 1.0, 0.0);
-	fprintf(fp, "<PCellData Scalars=\"%s\">\n", prefix);
-	fprintf(fp,
+	snapshotPrintf(&s, "<PCellData Scalars=\"%s\">\n", prefix);
+	snapshotPrintf(&s,
 			"<PDataArray type=\"Float32\" Name=\"%s\" format=\"appended\" offset=\"0\"/>\n",
 			prefix);
-	fprintf(fp, "</PCellData>\n");
+	snapshotPrintf(&s, "</PCellData>\n");
 
 	for (int piece = 0; piece < CHUNKS_X*CHUNKS_Y; piece++) {
-		fprintf(fp, "<Piece Extent=\"%d %d %d %d 0 0\" Source=\"%s%s%d%s%d%s\"/>",
+		snapshotPrintf(&s, "<Piece Extent=\"%d %d %d %d 0 0\" Source=\"%s%s%d%s%d%s\"/>",
 			       domains[piece].colStart, domains[piece].colEnd,  domains[piece].rowStart,  domains[piece].rowEnd,
 		       	       prefix,"step",cycleNum, "thread", piece, ".vti");
 	}
 
-	fprintf(fp, "</PImageData>\n");
-	fprintf(fp, "</VTKFile>\n");
-	fclose(fp);
+	snapshotPrintf(&s, "</PImageData>\n");
+	snapshotPrintf(&s, "</VTKFile>\n");
+	if (writeSnapshot(&s, filename) != 0) {
+		perror(filename);
+		return -1;
+	}
+	return 0;
 }
 
-void writeVTK2(int cycleNum, int id, bitvector *fieldVector, char prefix[1024], int w, int h, domain* domains) {
+int writeVTK2(int cycleNum, int id, bitvector *fieldVector, const char *prefix, int w, int h, domain* domains, arena *scratch) {
 	char filename[2048];
 	//int x,y;
 
 	long nxy = w * h * sizeof(float);
 
 	snprintf(filename, sizeof(filename), "%s%s%d%s%d%s", prefix,"step",cycleNum, "thread", id, ".vti");
-	FILE* fp = fopen(filename, "w");
+	snapshot s;
+	initSnapshot(&s, scratch, SNAPSHOT_HEADER_SIZE + nxy);
 
-	fprintf(fp, "<?xml version=\"1.0\"?>\n");
-	fprintf(fp,
+	snapshotPrintf(&s, "<?xml version=\"1.0\"?>\n");
+	snapshotPrintf(&s,
 			"<VTKFile type=\"ImageData\" version=\"0.1\" byte_order=\"LittleEndian\" header_type=\"UInt64\">\n");
-	fprintf(fp,
+	snapshotPrintf(&s,
 			"<ImageData WholeExtent=\"%d %d %d %d %d %d\" Origin=\"0 0 0\" Spacing=\"%le %le %le\">\n",
 			0, w, 0, h, 0, 0, 1.0, 1.0,
 			0.0);
-	fprintf(fp, "<Piece Extent=\"%d %d %d %d 0 0 \">\n", domains[id].colStart, domains[id].colEnd, domains[id].rowStart, domains[id].rowEnd);
-	fprintf(fp, "<CellData Scalars=\"%s\">\n", prefix);
-	fprintf(fp,
+	snapshotPrintf(&s, "<Piece Extent=\"%d %d %d %d 0 0 \">\n", domains[id].colStart, domains[id].colEnd, domains[id].rowStart, domains[id].rowEnd);
+	snapshotPrintf(&s, "<CellData Scalars=\"%s\">\n", prefix);
+	snapshotPrintf(&s,
 			"<DataArray type=\"Float32\" Name=\"%s\" format=\"appended\" offset=\"0\"/>\n",
 			prefix);
-	fprintf(fp, "</CellData>\n");
-	fprintf(fp, "</Piece>\n");
-	fprintf(fp, "</ImageData>\n");
-	fprintf(fp, "<AppendedData encoding=\"raw\">\n");
-	fprintf(fp, "_");
-	fwrite((unsigned char*) &nxy, sizeof(long), 1, fp);
+	snapshotPrintf(&s, "</CellData>\n");
+	snapshotPrintf(&s, "</Piece>\n");
+	snapshotPrintf(&s, "</ImageData>\n");
+	snapshotPrintf(&s, "<AppendedData encoding=\"raw\">\n");
+	snapshotPrintf(&s, "_");
+	snapshotWrite(&s, &nxy, sizeof(long));
 
 	for (int row = domains[id].rowStart; row < domains[id].rowEnd; row++) {
 		for (int col = domains[id].colStart; col < domains[id].colEnd; col++) {
 			float value = getField(row * sizeX + col, fieldVector);
-			fwrite((unsigned char*) &value, sizeof(float), 1, fp);
+			snapshotWrite(&s, &value, sizeof(float));
 		}
 	}
 
-	fprintf(fp, "\n</AppendedData>\n");
-	fprintf(fp, "</VTKFile>\n");
-	fclose(fp);
+	snapshotPrintf(&s, "\n</AppendedData>\n");
+	snapshotPrintf(&s, "</VTKFile>\n");
+	if (writeSnapshot(&s, filename) != 0) {
+		perror(filename);
+		return -1;
+	}
+	return 0;
 }
 
-void cycle(int cycleNum, bitvector *fieldVector, bitvector *nextFieldVector,
-		int fieldVectorLength, domain *domains) {
+// returns the number of output files that could not be written
+int cycle(int cycleNum, bitvector *fieldVector, bitvector *nextFieldVector,
+		int fieldVectorLength, domain *domains, arena *scratch) {
+	if (!writeOutput) {
+#pragma omp parallel num_threads(CHUNKS_X * CHUNKS_Y)
+		cycleSubdomain(domains[omp_get_thread_num()], fieldVector,
+				nextFieldVector);
+		return 0;
+	}
+
 	for (int i = 0; i < CHUNKS_X * CHUNKS_Y; i++) {
 		printf(
 				"Domain %d: rowStart: %d, rowEnd: %d, colStart: %d, colEnd: %d\n",
@@ -219,16 +253,19 @@ void cycle(int cycleNum, bitvector *fieldVector, bitvector *nextFieldVector,
 				domains[i].colEnd);
 	}
 
-#pragma omp parallel num_threads(CHUNKS_X * CHUNKS_Y)
+	int failures = 0;
+#pragma omp parallel num_threads(CHUNKS_X * CHUNKS_Y) reduction(+:failures)
 	{
 		printf("Thread %d starting subdomain\n", omp_get_thread_num());
 		cycleSubdomain(domains[omp_get_thread_num()], fieldVector,
 				nextFieldVector);
-		writeVTK2(cycleNum, omp_get_thread_num(), fieldVector, "gol", sizeX, sizeY, domains);
+		failures += writeVTK2(cycleNum, omp_get_thread_num(), fieldVector, "gol", sizeX, sizeY, domains,
+				&scratch[omp_get_thread_num()]) != 0;
 		printf("Thread %d finished subdomain. Waiting...\n",
 				omp_get_thread_num());
 	}
 	printf("All threads finished and synchronized\n");
+	return failures;
 }
 
 void domainDecomposition(domain *domains) {
@@ -250,34 +287,69 @@ void domainDecomposition(domain *domains) {
 	}
 }
 
-void cycleAndMeasureTime(int cycleNum, bitvector *fieldVector, bitvector *nextFieldVector,
-		int fieldVectorLength) {
+// returns 0 on success and -1 if output files could not be written
+int cycleAndMeasureTime(int cycleNum, bitvector *fieldVector, bitvector *nextFieldVector,
+		int fieldVectorLength, arena *scratch) {
+	long allocationsBefore = allocationCount();
 	domain domains[CHUNKS_X * CHUNKS_Y];
 	domainDecomposition(domains);
 	
-	writePVTK(cycleNum, "gol", domains);
+	int failures = 0;
+	if (writeOutput)
+		failures += writePVTK(cycleNum, "gol", domains, &scratch[0]) != 0;
 
 	struct timespec start, end;
 	clock_gettime(CLOCK_MONOTONIC, &start);
-	cycle(cycleNum, fieldVector, nextFieldVector, fieldVectorLength, domains);
+	failures += cycle(cycleNum, fieldVector, nextFieldVector, fieldVectorLength, domains, scratch);
 	clock_gettime(CLOCK_MONOTONIC, &end);
 
 	double elapsedSeconds = (end.tv_sec - start.tv_sec) * 1E9;
 	double elapsedNanos = end.tv_nsec - start.tv_nsec;
 	double totalElapsedNanos = elapsedSeconds + elapsedNanos;
-	printf("Elapsed time during cycle: %fms\n\n", totalElapsedNanos / 1E6);
+	kernelNanos += totalElapsedNanos;
+	printf("Elapsed time during cycle: %fms\n", totalElapsedNanos / 1E6);
+	printf("Allocations during cycle: %ld\n\n",
+			allocationCount() - allocationsBefore);
+	return failures ? -1 : 0;
 }
 
-void cycleAndMeasureTimeWithoutPrint(int fieldVectorLength,
-		bitvector *fieldVector, bitvector *nextFieldVector) {
+// deterministic soup, the same hash as in gameoflifeMPI
+static int soup(int x, int y) {
+	unsigned int hash = (unsigned int) x * 2654435761u
+			^ (unsigned int) y * 2246822519u;
+	hash ^= hash >> 15;
+	hash *= 2654435761u;
+	return (hash >> 28) < 5;
+}
+
+int cycleAndMeasureTimeWithoutPrint(int fieldVectorLength,
+		bitvector *fieldVector, bitvector *nextFieldVector, arena *scratch) {
+	for (int row = 0; row < sizeY; row++) {
+		for (int col = 0; col < sizeX; col++) {
+			if (soup(col, row))
+				setField(row * sizeX + col, fieldVector);
+		}
+	}
+
 	for (int i = 0; i < RUNS_PER_THREAD; i++) {
-		cycleAndMeasureTime(i, fieldVector, nextFieldVector, fieldVectorLength);
+		if (cycleAndMeasureTime(i, fieldVector, nextFieldVector,
+				fieldVectorLength, scratch) != 0)
+			return -1;
 		swapArray(&fieldVector, &nextFieldVector);
 	}
+
+	long population = 0;
+	for (int i = 0; i < fieldVectorLength; i++) {
+		population += __builtin_popcount(fieldVector[i]);
+	}
+	printf("Population: %ld\n", population);
+	// read by scaling/scaling.py
+	printf("Kernel time: %.9fs\n", kernelNanos / 1E9);
+	return 0;
 }
 
-void cycleAndMeasureTimeWithPrint(int fieldVectorLength, bitvector *fieldVector,
-		bitvector *nextFieldVector) {
+int cycleAndMeasureTimeWithPrint(int fieldVectorLength, bitvector *fieldVector,
+		bitvector *nextFieldVector, arena *scratch) {
 	setField(0 * sizeY + 1, fieldVector);
 	setField(1 * sizeY + 2, fieldVector);
 	setField(2 * sizeY + 0, fieldVector);
@@ -286,21 +358,278 @@ void cycleAndMeasureTimeWithPrint(int fieldVectorLength, bitvector *fieldVector,
 	printField(fieldVector);
 
 	for (int i = 0; i < RUNS_PER_THREAD; i++) {
-		cycleAndMeasureTime(i, fieldVector, nextFieldVector, fieldVectorLength);
+		if (cycleAndMeasureTime(i, fieldVector, nextFieldVector,
+				fieldVectorLength, scratch) != 0)
+			return -1;
 		swapArray(&fieldVector, &nextFieldVector);
 		printField(fieldVector);
 	}
+	return 0;
 }
 
-int main(void) {
-	int fieldVectorLength = (sizeX * sizeY / INT_SIZE) + 1;
-	bitvector *fieldVector = calloc(fieldVectorLength, sizeof(bitvector));
-	bitvector *nextFieldVector = calloc(fieldVectorLength, sizeof(bitvector));
+void seedGliderGun(sparseField *field) {
+	static const int gun[][2] = { { 24, 0 }, { 22, 1 }, { 24, 1 }, { 12, 2 },
+			{ 13, 2 }, { 20, 2 }, { 21, 2 }, { 34, 2 }, { 35, 2 }, { 11, 3 }, {
+					15, 3 }, { 20, 3 }, { 21, 3 }, { 34, 3 }, { 35, 3 }, { 0, 4 },
+			{ 1, 4 }, { 10, 4 }, { 16, 4 }, { 20, 4 }, { 21, 4 }, { 0, 5 }, {
+					1, 5 }, { 10, 5 }, { 14, 5 }, { 16, 5 }, { 17, 5 }, { 22, 5 },
+			{ 24, 5 }, { 10, 6 }, { 16, 6 }, { 24, 6 }, { 11, 7 }, { 15, 7 }, {
+					12, 8 }, { 13, 8 } };
+	for (int i = 0; i < sizeof(gun) / sizeof(gun[0]); i++) {
+		sparseSetField(gun[i][0], gun[i][1], field);
+	}
+}
+
+void cycleSparseAndMeasureTime(int generations) {
+	tilePool pool;
+	initTilePool(&pool);
+	sparseField fieldA, fieldB;
+	initSparseField(&fieldA, &pool);
+	initSparseField(&fieldB, &pool);
+	sparseField *field = &fieldA;
+	sparseField *nextField = &fieldB;
+
+	seedGliderGun(field);
+
+	for (int i = 0; i < generations; i++) {
+		long allocationsBefore = allocationCount();
+		struct timespec start, end;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		cycleSparse(field, nextField);
+		clock_gettime(CLOCK_MONOTONIC, &end);
+
+		sparseField *temp = field;
+		field = nextField;
+		nextField = temp;
+
+		double elapsedSeconds = (end.tv_sec - start.tv_sec) * 1E9;
+		double elapsedNanos = end.tv_nsec - start.tv_nsec;
+		double totalElapsedNanos = elapsedSeconds + elapsedNanos;
+		printf(
+				"Generation %d: %ld cells in %d tiles, elapsed time: %fms, allocations: %ld\n",
+				i, sparsePopulation(field), field->activeCount,
+				totalElapsedNanos / 1E6, allocationCount() - allocationsBefore);
+	}
 
-	cycleAndMeasureTimeWithPrint(fieldVectorLength, fieldVector,
-			nextFieldVector);
+	freeSparseField(&fieldA);
+	freeSparseField(&fieldB);
+	freeTilePool(&pool);
+}
+
+// resumes from the newer of both board files if they hold a checkpoint,
+// existing board files are only replaced if replace is set. sizeGiven tells
+// whether width and height were requested or are only the defaults.
+int openOrCreateBoards(boardFile *boards, const char **paths, long width,
+		long height, int sizeGiven, int replace) {
+	if (!replace) {
+		int opened = openBoardFile(&boards[0], paths[0]) == 0;
+		if (opened && openBoardFile(&boards[1], paths[1]) == 0) {
+			if (boards[0].width == boards[1].width
+					&& boards[0].height == boards[1].height
+					&& (boards[0].header->generation >= 0
+							|| boards[1].header->generation >= 0)) {
+				int current = boards[1].header->generation
+						> boards[0].header->generation;
+				printf("Resuming %s at generation %ld\n", paths[current],
+						(long) boards[current].header->generation);
+				if (sizeGiven && (boards[current].width != width
+						|| boards[current].height != height))
+					printf("Ignoring the requested size %ldx%ld, "
+							"pass --new to start a new board\n", width, height);
+				return current;
+			}
+			closeBoardFile(&boards[1]);
+		}
+		if (opened)
+			closeBoardFile(&boards[0]);
 
-	free(fieldVector);
-	free(nextFieldVector);
+		if (access(paths[0], F_OK) == 0 || access(paths[1], F_OK) == 0) {
+			fprintf(stderr, "%s and %s hold no usable checkpoint, "
+					"pass --new to replace them\n", paths[0], paths[1]);
+			return -1;
+		}
+	}
+
+	if (createBoardFile(&boards[0], paths[0], width, height) != 0) {
+		perror(paths[0]);
+		return -1;
+	}
+	if (createBoardFile(&boards[1], paths[1], width, height) != 0) {
+		perror(paths[1]);
+		closeBoardFile(&boards[0]);
+		return -1;
+	}
+	mappedSetField(1, 0, &boards[0]);
+	mappedSetField(2, 1, &boards[0]);
+	mappedSetField(0, 2, &boards[0]);
+	mappedSetField(1, 2, &boards[0]);
+	mappedSetField(2, 2, &boards[0]);
+	if (checkpointBoardFile(&boards[0], 0) != 0) {
+		perror(paths[0]);
+		closeBoardFile(&boards[0]);
+		closeBoardFile(&boards[1]);
+		return -1;
+	}
+	return 0;
+}
+
+int cycleMappedAndMeasureTime(long width, long height, int sizeGiven,
+		int generations, int replace) {
+	const char *paths[2] = { "golboard0.bin", "golboard1.bin" };
+	boardFile boards[2];
+	int current = openOrCreateBoards(boards, paths, width, height, sizeGiven,
+			replace);
+	if (current < 0)
+		return EXIT_FAILURE;
+
+	long generation = boards[current].header->generation;
+	long bandRows = mappedBandRows(&boards[current], MAPPED_BAND_BYTES);
+	double boardBytes = (double) boards[current].rowWords
+			* boards[current].height * sizeof(uint64_t);
+	printf("Board %ldx%ld at generation %ld, %ld rows per band\n",
+			boards[current].width, boards[current].height, generation,
+			bandRows);
+
+	for (int i = 0; i < generations; i++) {
+		int next = 1 - current;
+		struct timespec start, end;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		long population = cycleMapped(&boards[current], &boards[next],
+				bandRows);
+		// a run that could not save its checkpoint must not look successful
+		if (checkpointBoardFile(&boards[next], ++generation) != 0) {
+			perror("checkpoint");
+			closeBoardFile(&boards[0]);
+			closeBoardFile(&boards[1]);
+			return EXIT_FAILURE;
+		}
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		current = next;
+
+		double elapsedSeconds = (end.tv_sec - start.tv_sec) * 1E9;
+		double elapsedNanos = end.tv_nsec - start.tv_nsec;
+		double totalElapsedNanos = elapsedSeconds + elapsedNanos;
+		// every generation reads one board and writes the other
+		printf(
+				"Generation %ld: %ld cells, elapsed time: %fms, throughput: %fMB/s\n",
+				generation, population, totalElapsedNanos / 1E6,
+				2 * boardBytes / totalElapsedNanos * 1E3);
+	}
+
+	closeBoardFile(&boards[0]);
+	closeBoardFile(&boards[1]);
 	return EXIT_SUCCESS;
 }
+
+// strtol for command line counts, fails unless text is a whole positive int
+static int parsePositive(const char *text, int *value) {
+	char *end;
+	errno = 0;
+	long parsed = strtol(text, &end, 0);
+	if (errno != 0 || *end != '\0' || end == text || parsed < 1
+			|| parsed > INT_MAX)
+		return -1;
+	*value = parsed;
+	return 0;
+}
+
+int main(int argc, char **argv) {
+	// gameoflife sparse [generations] runs the unbounded engine
+	if (argc > 1 && strcmp(argv[1], "sparse") == 0) {
+		int generations = RUNS_PER_THREAD;
+		if (argc > 2)
+			generations = strtol(argv[2], NULL, 0);
+		cycleSparseAndMeasureTime(generations);
+		return EXIT_SUCCESS;
+	}
+
+	// gameoflife mapped [--new] [width] [height] [generations] steps board
+	// files on disk, --new replaces existing board files instead of resuming
+	if (argc > 1 && strcmp(argv[1], "mapped") == 0) {
+		int replace = argc > 2 && strcmp(argv[2], "--new") == 0;
+		int first = 2 + replace;
+		int sizeGiven = argc > first;
+		long width = argc > first ? strtol(argv[first], NULL, 0) : 16384;
+		long height = argc > first + 1 ? strtol(argv[first + 1], NULL, 0) : 16384;
+		int generations = argc > first + 2 ?
+				strtol(argv[first + 2], NULL, 0) : RUNS_PER_THREAD;
+		if (width < MIN_BOARD_SIZE || height < MIN_BOARD_SIZE
+				|| generations < 1) {
+			fprintf(stderr, "mapped needs width and height of at least 3 "
+					"and at least one generation\n");
+			return EXIT_FAILURE;
+		}
+		return cycleMappedAndMeasureTime(width, height, sizeGiven, generations,
+				replace);
+	}
+
+	// gameoflife dense <size> <chunksX> <chunksY> [generations] skips all output
+	int benchmark = argc > 1 && strcmp(argv[1], "dense") == 0;
+	if (benchmark) {
+		if (argc < 5 || argc > 6 || parsePositive(argv[2], &sizeX) != 0
+				|| parsePositive(argv[3], &CHUNKS_X) != 0
+				|| parsePositive(argv[4], &CHUNKS_Y) != 0
+				|| (argc > 5 && parsePositive(argv[5], &RUNS_PER_THREAD) != 0)
+				|| CHUNKS_X > sizeX || CHUNKS_Y > sizeX) {
+			fprintf(stderr, "usage: gameoflife dense <size> <chunksX> <chunksY> "
+					"[generations], all positive, chunks at most size\n");
+			return EXIT_FAILURE;
+		}
+		sizeY = sizeX;
+		writeOutput = 0;
+
+		// every subdomain has to start on a bitvector boundary, otherwise
+		// two threads update the same word in setField and unsetField
+		long multiple = (long) INT_SIZE * CHUNKS_X;
+		long rounded = (sizeX + multiple - 1) / multiple * multiple;
+		// cells are addressed with int indices
+		if (rounded > INT_MAX / rounded) {
+			fprintf(stderr, "board size %d is too large\n", sizeX);
+			return EXIT_FAILURE;
+		}
+		if (rounded != sizeX) {
+			printf("Board size rounded up from %d to %ld\n", sizeX, rounded);
+			sizeX = sizeY = rounded;
+		}
+	}
+
+	int fieldVectorLength = (sizeX * sizeY / INT_SIZE) + 1;
+	size_t fieldVectorSize = fieldVectorLength * sizeof(bitvector);
+
+	// both boards share one arena, fresh mappings are already zeroed
+	arena boards;
+	if (initArena(&boards, 2 * fieldVectorSize + 64) != 0) {
+		perror("initArena");
+		return EXIT_FAILURE;
+	}
+	bitvector *fieldVector = arenaAlloc(&boards, fieldVectorSize);
+	bitvector *nextFieldVector = arenaAlloc(&boards, fieldVectorSize);
+
+	// one scratch arena per thread for the output stage, none without output
+	arena scratch[CHUNKS_X * CHUNKS_Y];
+	int scratchCount = 0;
+	int result = 0;
+	for (; writeOutput && scratchCount < CHUNKS_X * CHUNKS_Y; scratchCount++) {
+		if (initArena(&scratch[scratchCount],
+				SNAPSHOT_HEADER_SIZE * (CHUNKS_X * CHUNKS_Y + 1)
+						+ sizeX * sizeY * sizeof(float)) != 0) {
+			perror("initArena");
+			result = -1;
+			break;
+		}
+	}
+
+	if (result == 0 && benchmark) {
+		result = cycleAndMeasureTimeWithoutPrint(fieldVectorLength, fieldVector,
+				nextFieldVector, scratch);
+	} else if (result == 0) {
+		result = cycleAndMeasureTimeWithPrint(fieldVectorLength, fieldVector,
+				nextFieldVector, scratch);
+	}
+
+	for (int i = 0; i < scratchCount; i++) {
+		freeArena(&scratch[i]);
+	}
+	freeArena(&boards);
+	return result == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
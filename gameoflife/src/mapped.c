@@ -0,0 +1,219 @@
+#define _GNU_SOURCE
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <omp.h>
+#include "bitlife.h"
+#include "mapped.h"
+
+static const size_t HEADER_SIZE = 4096;
+static const char MAGIC[8] = "GOLBOARD";
+
+static size_t cellBytes(long rowWords, long height) {
+	return (size_t) rowWords * height * sizeof(uint64_t);
+}
+
+static int mapBoard(boardFile *board, long width, long height) {
+	board->width = width;
+	board->height = height;
+	board->rowWords = (width + 63) / 64;
+	board->mapSize = HEADER_SIZE + cellBytes(board->rowWords, height);
+	board->map = mmap(NULL, board->mapSize, PROT_READ | PROT_WRITE,
+	MAP_SHARED, board->fd, 0);
+	if (board->map == MAP_FAILED) {
+		close(board->fd);
+		return -1;
+	}
+	// boards are always streamed from top to bottom
+	madvise(board->map, board->mapSize, MADV_SEQUENTIAL);
+	board->header = (boardHeader*) board->map;
+	board->cells = (uint64_t*) (board->map + HEADER_SIZE);
+	return 0;
+}
+
+int createBoardFile(boardFile *board, const char *path, long width,
+		long height) {
+	board->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (board->fd < 0)
+		return -1;
+
+	// the file stays sparse until cells are written
+	long rowWords = (width + 63) / 64;
+	if (ftruncate(board->fd, HEADER_SIZE + cellBytes(rowWords, height)) != 0) {
+		close(board->fd);
+		return -1;
+	}
+	if (mapBoard(board, width, height) != 0)
+		return -1;
+
+	memcpy(board->header->magic, MAGIC, sizeof(MAGIC));
+	board->header->width = width;
+	board->header->height = height;
+	// no generation has been checkpointed yet
+	board->header->generation = -1;
+	return 0;
+}
+
+int openBoardFile(boardFile *board, const char *path) {
+	board->fd = open(path, O_RDWR);
+	if (board->fd < 0)
+		return -1;
+
+	boardHeader header;
+	struct stat st;
+	if (pread(board->fd, &header, sizeof(header), 0) != sizeof(header)
+			|| memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0
+			|| header.width < MIN_BOARD_SIZE || header.height < MIN_BOARD_SIZE
+			|| fstat(board->fd, &st) != 0
+			|| st.st_size
+					< HEADER_SIZE
+							+ cellBytes((header.width + 63) / 64,
+									header.height)) {
+		close(board->fd);
+		errno = EINVAL;
+		return -1;
+	}
+	return mapBoard(board, header.width, header.height);
+}
+
+int closeBoardFile(boardFile *board) {
+	int result = munmap(board->map, board->mapSize);
+	if (close(board->fd) != 0)
+		result = -1;
+	return result;
+}
+
+int checkpointBoardFile(boardFile *board, long generation) {
+	if (msync(board->cells, cellBytes(board->rowWords, board->height), MS_SYNC)
+			!= 0)
+		return -1;
+	board->header->generation = generation;
+	return msync(board->map, HEADER_SIZE, MS_SYNC);
+}
+
+static uint64_t* rowOf(boardFile *board, long row) {
+	return board->cells + row * board->rowWords;
+}
+
+void mappedSetField(long x, long y, boardFile *board) {
+	rowOf(board, y)[x / 64] |= (uint64_t) 1 << (x % 64);
+}
+
+int mappedGetField(long x, long y, boardFile *board) {
+	return (rowOf(board, y)[x / 64] >> (x % 64)) & 1;
+}
+
+long mappedPopulation(boardFile *board) {
+	long population = 0;
+	size_t words = (size_t) board->rowWords * board->height;
+	for (size_t i = 0; i < words; i++) {
+		population += __builtin_popcountll(board->cells[i]);
+	}
+	return population;
+}
+
+// rows outside the board are passed as NULL and read as dead cells
+static inline uint64_t wordOf(const uint64_t *row, long i) {
+	return row ? row[i] : 0;
+}
+
+static inline uint64_t westOf(const uint64_t *row, long i) {
+	if (!row)
+		return 0;
+	return (row[i] << 1) | (i > 0 ? row[i - 1] >> 63 : 0);
+}
+
+static inline uint64_t eastOf(const uint64_t *row, long i, long rowWords) {
+	if (!row)
+		return 0;
+	return (row[i] >> 1) | (i + 1 < rowWords ? row[i + 1] << 63 : 0);
+}
+
+long cycleMappedBand(long rowStart, long rowEnd, boardFile *board,
+		boardFile *nextBoard) {
+	long rowWords = board->rowWords;
+	// padding bits behind the last column must stay dead
+	uint64_t lastWordMask =
+			board->width % 64 == 0 ?
+					~(uint64_t) 0 : ((uint64_t) 1 << (board->width % 64)) - 1;
+	long population = 0;
+
+	for (long row = rowStart; row < rowEnd; row++) {
+		const uint64_t *above = row > 0 ? rowOf(board, row - 1) : NULL;
+		const uint64_t *middle = rowOf(board, row);
+		const uint64_t *below =
+				row + 1 < board->height ? rowOf(board, row + 1) : NULL;
+		uint64_t *next = rowOf(nextBoard, row);
+
+		for (long i = 0; i < rowWords; i++) {
+			next[i] = evolveWord(westOf(above, i), wordOf(above, i),
+					eastOf(above, i, rowWords), westOf(middle, i), middle[i],
+					eastOf(middle, i, rowWords), westOf(below, i),
+					wordOf(below, i), eastOf(below, i, rowWords));
+		}
+		next[rowWords - 1] &= lastWordMask;
+
+		for (long i = 0; i < rowWords; i++) {
+			population += __builtin_popcountll(next[i]);
+		}
+	}
+	return population;
+}
+
+// applies advice to the pages holding rows [rowStart, rowEnd)
+static void adviseRows(boardFile *board, long rowStart, long rowEnd,
+		int advice) {
+	if (rowStart < 0)
+		rowStart = 0;
+	if (rowEnd > board->height)
+		rowEnd = board->height;
+	if (rowStart >= rowEnd)
+		return;
+
+	size_t pageSize = sysconf(_SC_PAGESIZE);
+	size_t start = HEADER_SIZE + cellBytes(board->rowWords, rowStart);
+	size_t end = HEADER_SIZE + cellBytes(board->rowWords, rowEnd);
+	start = start / pageSize * pageSize;
+	madvise(board->map + start, end - start, advice);
+}
+
+static void startWriteback(boardFile *board, long rowStart, long rowEnd) {
+	off_t start = HEADER_SIZE + cellBytes(board->rowWords, rowStart);
+	off_t end = HEADER_SIZE + cellBytes(board->rowWords, rowEnd);
+	sync_file_range(board->fd, start, end - start, SYNC_FILE_RANGE_WRITE);
+}
+
+long cycleMapped(boardFile *board, boardFile *nextBoard, long bandRows) {
+	long population = 0;
+
+	for (long bandStart = 0; bandStart < board->height; bandStart +=
+			bandRows) {
+		long bandEnd = bandStart + bandRows;
+		if (bandEnd > board->height)
+			bandEnd = board->height;
+
+		adviseRows(board, bandEnd, bandEnd + bandRows, MADV_WILLNEED);
+
+		long rows = bandEnd - bandStart;
+#pragma omp parallel reduction(+:population)
+		{
+			int threads = omp_get_num_threads();
+			int id = omp_get_thread_num();
+			population += cycleMappedBand(bandStart + id * rows / threads,
+					bandStart + (id + 1) * rows / threads, board, nextBoard);
+		}
+
+		startWriteback(nextBoard, bandStart, bandEnd);
+		// only the last row of the previous band was needed for this one
+		adviseRows(board, bandStart - bandRows, bandStart - 1, MADV_DONTNEED);
+	}
+	return population;
+}
+
+long mappedBandRows(boardFile *board, size_t bandBytes) {
+	long rows = bandBytes / cellBytes(board->rowWords, 1);
+	return rows > 0 ? rows : 1;
+}
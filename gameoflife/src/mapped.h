@@ -0,0 +1,68 @@
+#ifndef MAPPED_H_
+#define MAPPED_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Board stored in a memory mapped file, for boards larger than RAM. The file
+ * starts with one page of header, followed by the rows of the board packed to
+ * one bit per cell, each row padded to whole 64 bit words. Cells outside the
+ * board are dead, like in the dense engine.
+ *
+ * A board file is also a checkpoint: the header generation is only advanced
+ * after the cells of that generation reached the disk.
+ */
+struct boardHeader {
+	char magic[8];
+	int64_t width;
+	int64_t height;
+	int64_t generation;
+};
+typedef struct boardHeader boardHeader;
+
+struct boardFile {
+	int fd;
+	char *map;
+	size_t mapSize;
+	boardHeader *header;
+	uint64_t *cells;
+	long width;
+	long height;
+	long rowWords;
+};
+typedef struct boardFile boardFile;
+
+// smallest width and height of a board, the glider seed needs 3x3 cells
+static const long MIN_BOARD_SIZE = 3;
+
+// all functions returning int return 0 on success and -1 with errno set
+int createBoardFile(boardFile *board, const char *path, long width,
+		long height);
+// fails with EINVAL unless the file holds a board of at least MIN_BOARD_SIZE
+int openBoardFile(boardFile *board, const char *path);
+int closeBoardFile(boardFile *board);
+
+// flushes the cells, then records generation in the header
+int checkpointBoardFile(boardFile *board, long generation);
+
+void mappedSetField(long x, long y, boardFile *board);
+int mappedGetField(long x, long y, boardFile *board);
+long mappedPopulation(boardFile *board);
+
+// computes rows [rowStart, rowEnd) of nextBoard from board, returns their population
+long cycleMappedBand(long rowStart, long rowEnd, boardFile *board,
+		boardFile *nextBoard);
+
+/*
+ * Computes one generation band by band. While a band is computed the next one
+ * is prefetched, finished bands of nextBoard are handed to writeback and
+ * bands of board that are no longer needed are dropped from memory. Returns
+ * the population of nextBoard.
+ */
+long cycleMapped(boardFile *board, boardFile *nextBoard, long bandRows);
+
+// rows per band so that one band of a board covers about bandBytes
+long mappedBandRows(boardFile *board, size_t bandBytes);
+
+#endif /* MAPPED_H_ */
@@ -0,0 +1,65 @@
+#include <stdarg.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "snapshot.h"
+
+void initSnapshot(snapshot *s, arena *scratch, size_t capacity) {
+	resetArena(scratch);
+	s->buffer = arenaAlloc(scratch, capacity);
+	s->capacity = s->buffer ? capacity : 0;
+	s->length = 0;
+	s->failed = s->buffer == NULL;
+}
+
+void snapshotPrintf(snapshot *s, const char *format, ...) {
+	if (s->failed)
+		return;
+
+	va_list args;
+	va_start(args, format);
+	int written = vsnprintf(s->buffer + s->length, s->capacity - s->length,
+			format, args);
+	va_end(args);
+
+	if (written < 0 || s->length + written >= s->capacity) {
+		s->failed = 1;
+		return;
+	}
+	s->length += written;
+}
+
+void snapshotWrite(snapshot *s, const void *data, size_t size) {
+	if (s->failed)
+		return;
+	if (s->length + size > s->capacity) {
+		s->failed = 1;
+		return;
+	}
+	memcpy(s->buffer + s->length, data, size);
+	s->length += size;
+}
+
+int writeSnapshot(snapshot *s, const char *filename) {
+	if (s->failed) {
+		errno = ENOBUFS;
+		return -1;
+	}
+
+	int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		return -1;
+
+	size_t done = 0;
+	while (done < s->length) {
+		ssize_t written = write(fd, s->buffer + done, s->length - done);
+		if (written <= 0) {
+			close(fd);
+			return -1;
+		}
+		done += written;
+	}
+	return close(fd);
+}
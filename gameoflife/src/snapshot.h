@@ -0,0 +1,30 @@
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+#include <stddef.h>
+#include "arena.h"
+
+/*
+ * Output file assembled in memory and written with a single system call.
+ * The buffer lives in a per thread scratch arena and is reused for every
+ * generation, so writing snapshots does not allocate in steady state.
+ */
+struct snapshot {
+	char *buffer;
+	size_t length;
+	size_t capacity;
+	// set once the buffer was missing or too small, the file is not written
+	int failed;
+};
+typedef struct snapshot snapshot;
+
+// resets scratch, everything previously allocated from it becomes invalid
+void initSnapshot(snapshot *s, arena *scratch, size_t capacity);
+void snapshotPrintf(snapshot *s, const char *format, ...)
+		__attribute__((format(printf, 2, 3)));
+void snapshotWrite(snapshot *s, const void *data, size_t size);
+
+// returns -1 with errno set if writing failed or the snapshot is incomplete
+int writeSnapshot(snapshot *s, const char *filename);
+
+#endif /* SNAPSHOT_H_ */
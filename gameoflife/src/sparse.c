@@ -0,0 +1,311 @@
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "arena.h"
+#include "bitlife.h"
+#include "sparse.h"
+
+static const int INITIAL_POOL_SIZE = 64;
+static const int INITIAL_MAP_SIZE = 64;
+
+void initTilePool(tilePool *pool) {
+	pool->capacity = INITIAL_POOL_SIZE;
+	pool->used = 0;
+	pool->freeCount = 0;
+	pool->tiles = malloc(pool->capacity * sizeof(tile));
+	countAllocation();
+	pool->freeList = malloc(pool->capacity * sizeof(int));
+	countAllocation();
+}
+
+void freeTilePool(tilePool *pool) {
+	free(pool->tiles);
+	free(pool->freeList);
+}
+
+static int allocTile(tilePool *pool, int tx, int ty) {
+	int index;
+	if (pool->freeCount > 0) {
+		index = pool->freeList[--pool->freeCount];
+	} else {
+		if (pool->used == pool->capacity) {
+			pool->capacity *= 2;
+			pool->tiles = realloc(pool->tiles, pool->capacity * sizeof(tile));
+			countAllocation();
+			pool->freeList = realloc(pool->freeList,
+					pool->capacity * sizeof(int));
+			countAllocation();
+		}
+		index = pool->used++;
+	}
+
+	tile *t = &pool->tiles[index];
+	t->tx = tx;
+	t->ty = ty;
+	memset(t->rows, 0, sizeof(t->rows));
+	return index;
+}
+
+static void freeTile(tilePool *pool, int index) {
+	pool->freeList[pool->freeCount++] = index;
+}
+
+static uint64_t tileKey(int tx, int ty) {
+	return ((uint64_t) (uint32_t) tx << 32) | (uint32_t) ty;
+}
+
+static int slotOf(uint64_t key, int mapCapacity) {
+	return (int) ((key * 0x9E3779B97F4A7C15ull) >> 32) & (mapCapacity - 1);
+}
+
+static void putSlot(sparseField *field, int index) {
+	tile *t = &field->pool->tiles[index];
+	uint64_t key = tileKey(t->tx, t->ty);
+	int slot = slotOf(key, field->mapCapacity);
+	while (field->values[slot] >= 0) {
+		slot = (slot + 1) & (field->mapCapacity - 1);
+	}
+	field->keys[slot] = key;
+	field->values[slot] = index;
+}
+
+static void rebuildMap(sparseField *field) {
+	for (int i = 0; i < field->mapCapacity; i++) {
+		field->values[i] = -1;
+	}
+	for (int i = 0; i < field->activeCount; i++) {
+		putSlot(field, field->active[i]);
+	}
+}
+
+void initSparseField(sparseField *field, tilePool *pool) {
+	field->pool = pool;
+	field->mapCapacity = INITIAL_MAP_SIZE;
+	field->keys = malloc(field->mapCapacity * sizeof(uint64_t));
+	countAllocation();
+	field->values = malloc(field->mapCapacity * sizeof(int));
+	countAllocation();
+	field->activeCapacity = INITIAL_MAP_SIZE / 2;
+	field->active = malloc(field->activeCapacity * sizeof(int));
+	countAllocation();
+	field->activeCount = 0;
+	rebuildMap(field);
+}
+
+void freeSparseField(sparseField *field) {
+	clearSparseField(field);
+	free(field->keys);
+	free(field->values);
+	free(field->active);
+}
+
+void clearSparseField(sparseField *field) {
+	for (int i = 0; i < field->activeCount; i++) {
+		freeTile(field->pool, field->active[i]);
+	}
+	field->activeCount = 0;
+	rebuildMap(field);
+}
+
+static int findTile(sparseField *field, int tx, int ty) {
+	uint64_t key = tileKey(tx, ty);
+	int slot = slotOf(key, field->mapCapacity);
+	while (field->values[slot] >= 0) {
+		if (field->keys[slot] == key)
+			return field->values[slot];
+		slot = (slot + 1) & (field->mapCapacity - 1);
+	}
+	return -1;
+}
+
+static int insertTile(sparseField *field, int tx, int ty) {
+	int index = findTile(field, tx, ty);
+	if (index >= 0)
+		return index;
+
+	// keep the map at most half full
+	if ((field->activeCount + 1) * 2 > field->mapCapacity) {
+		field->mapCapacity *= 2;
+		field->keys = realloc(field->keys,
+				field->mapCapacity * sizeof(uint64_t));
+		countAllocation();
+		field->values = realloc(field->values,
+				field->mapCapacity * sizeof(int));
+		countAllocation();
+		field->activeCapacity = field->mapCapacity / 2;
+		field->active = realloc(field->active,
+				field->activeCapacity * sizeof(int));
+		countAllocation();
+		rebuildMap(field);
+	}
+
+	index = allocTile(field->pool, tx, ty);
+	field->active[field->activeCount++] = index;
+	putSlot(field, index);
+	return index;
+}
+
+static tile* lookupTile(sparseField *field, int tx, int ty) {
+	int index = findTile(field, tx, ty);
+	return index < 0 ? NULL : &field->pool->tiles[index];
+}
+
+// floor division, so that negative coordinates land in the correct tile
+static int tileCoord(long v) {
+	return (int) (v >= 0 ? v / TILE_SIZE : -((-v - 1) / TILE_SIZE) - 1);
+}
+
+static int tileOffset(long v) {
+	return (int) (v - (long) tileCoord(v) * TILE_SIZE);
+}
+
+void sparseSetField(long x, long y, sparseField *field) {
+	int index = insertTile(field, tileCoord(x), tileCoord(y));
+	tile *t = &field->pool->tiles[index];
+	t->rows[tileOffset(y)] |= (tilerow) 1 << tileOffset(x);
+}
+
+void sparseUnsetField(long x, long y, sparseField *field) {
+	tile *t = lookupTile(field, tileCoord(x), tileCoord(y));
+	if (t)
+		t->rows[tileOffset(y)] &= ~((tilerow) 1 << tileOffset(x));
+}
+
+int sparseGetField(long x, long y, sparseField *field) {
+	tile *t = lookupTile(field, tileCoord(x), tileCoord(y));
+	if (!t)
+		return 0;
+	return (t->rows[tileOffset(y)] >> tileOffset(x)) & 1;
+}
+
+long sparsePopulation(sparseField *field) {
+	long population = 0;
+	for (int i = 0; i < field->activeCount; i++) {
+		tile *t = &field->pool->tiles[field->active[i]];
+		for (int row = 0; row < TILE_SIZE; row++) {
+			population += __builtin_popcountll(t->rows[row]);
+		}
+	}
+	return population;
+}
+
+static int isEmpty(tile *t) {
+	tilerow any = 0;
+	for (int row = 0; row < TILE_SIZE; row++) {
+		any |= t->rows[row];
+	}
+	return any == 0;
+}
+
+static tilerow rowOf(tile *t, int row) {
+	return t ? t->rows[row] : 0;
+}
+
+static void cycleTile(tile *next, sparseField *field) {
+	tile *around[3][3];
+	for (int dy = -1; dy <= 1; dy++) {
+		for (int dx = -1; dx <= 1; dx++) {
+			around[dy + 1][dx + 1] = lookupTile(field, next->tx + dx,
+					next->ty + dy);
+		}
+	}
+
+	// rows -1 .. TILE_SIZE, each shifted so bit i holds the cell left/right of i
+	tilerow west[TILE_SIZE + 2];
+	tilerow centre[TILE_SIZE + 2];
+	tilerow east[TILE_SIZE + 2];
+	for (int r = -1; r <= TILE_SIZE; r++) {
+		int ty = r < 0 ? 0 : (r == TILE_SIZE ? 2 : 1);
+		int row = r < 0 ? TILE_SIZE - 1 : (r == TILE_SIZE ? 0 : r);
+		tilerow left = rowOf(around[ty][0], row);
+		tilerow middle = rowOf(around[ty][1], row);
+		tilerow right = rowOf(around[ty][2], row);
+		west[r + 1] = (middle << 1) | (left >> (TILE_SIZE - 1));
+		centre[r + 1] = middle;
+		east[r + 1] = (middle >> 1) | (right << (TILE_SIZE - 1));
+	}
+
+	for (int row = 0; row < TILE_SIZE; row++) {
+		next->rows[row] = evolveWord(west[row], centre[row], east[row],
+				west[row + 1], centre[row + 1], east[row + 1], west[row + 2],
+				centre[row + 2], east[row + 2]);
+	}
+}
+
+void cycleSparseSubdomain(int first, int last, sparseField *field,
+		sparseField *nextField) {
+	for (int i = first; i < last; i++) {
+		cycleTile(&nextField->pool->tiles[nextField->active[i]], field);
+	}
+}
+
+// every tile with living cells on an edge may spill into the tile behind it
+static void prepareNextTiles(sparseField *field, sparseField *nextField) {
+	for (int i = 0; i < field->activeCount; i++) {
+		tile *t = &field->pool->tiles[field->active[i]];
+		int tx = t->tx;
+		int ty = t->ty;
+
+		tilerow leftColumn = 0;
+		tilerow rightColumn = 0;
+		for (int row = 0; row < TILE_SIZE; row++) {
+			leftColumn |= t->rows[row] & 1;
+			rightColumn |= t->rows[row] >> (TILE_SIZE - 1);
+		}
+		tilerow top = t->rows[0];
+		tilerow bottom = t->rows[TILE_SIZE - 1];
+		tilerow corner = (tilerow) 1 << (TILE_SIZE - 1);
+
+		// insertTile may move the pool, t must not be used below
+		insertTile(nextField, tx, ty);
+		if (top)
+			insertTile(nextField, tx, ty - 1);
+		if (bottom)
+			insertTile(nextField, tx, ty + 1);
+		if (leftColumn)
+			insertTile(nextField, tx - 1, ty);
+		if (rightColumn)
+			insertTile(nextField, tx + 1, ty);
+		if (top & 1)
+			insertTile(nextField, tx - 1, ty - 1);
+		if (top & corner)
+			insertTile(nextField, tx + 1, ty - 1);
+		if (bottom & 1)
+			insertTile(nextField, tx - 1, ty + 1);
+		if (bottom & corner)
+			insertTile(nextField, tx + 1, ty + 1);
+	}
+}
+
+static void releaseEmptyTiles(sparseField *field) {
+	int kept = 0;
+	for (int i = 0; i < field->activeCount; i++) {
+		int index = field->active[i];
+		if (isEmpty(&field->pool->tiles[index])) {
+			freeTile(field->pool, index);
+		} else {
+			field->active[kept++] = index;
+		}
+	}
+	if (kept != field->activeCount) {
+		field->activeCount = kept;
+		rebuildMap(field);
+	}
+}
+
+void cycleSparse(sparseField *field, sparseField *nextField) {
+	clearSparseField(nextField);
+	prepareNextTiles(field, nextField);
+
+	int tiles = nextField->activeCount;
+#pragma omp parallel
+	{
+		int threads = omp_get_num_threads();
+		int id = omp_get_thread_num();
+		cycleSparseSubdomain(id * tiles / threads, (id + 1) * tiles / threads,
+				field, nextField);
+	}
+
+	releaseEmptyTiles(nextField);
+	clearSparseField(field);
+}
@@ -0,0 +1,71 @@
+#ifndef SPARSE_H_
+#define SPARSE_H_
+
+#include <stdint.h>
+
+/*
+ * Sparse game of life on an unbounded plane. Only tiles of TILE_SIZE x
+ * TILE_SIZE cells that contain (or may soon contain) living cells are stored.
+ * Each tile row is one 64 bit word, bit i being the cell in column i.
+ */
+#define TILE_SIZE 64
+
+typedef uint64_t tilerow;
+
+struct tile {
+	int tx;
+	int ty;
+	tilerow rows[TILE_SIZE];
+};
+typedef struct tile tile;
+
+// tiles are handed out by index, so the pool may grow without invalidating them
+struct tilePool {
+	tile *tiles;
+	int capacity;
+	int used;
+	int *freeList;
+	int freeCount;
+};
+typedef struct tilePool tilePool;
+
+struct sparseField {
+	tilePool *pool;
+	// open addressing hash map from tile coordinates to tile index
+	uint64_t *keys;
+	int *values;
+	int mapCapacity;
+	// tile indices of all tiles in the map, in insertion order
+	int *active;
+	int activeCount;
+	int activeCapacity;
+};
+typedef struct sparseField sparseField;
+
+void initTilePool(tilePool *pool);
+void freeTilePool(tilePool *pool);
+
+void initSparseField(sparseField *field, tilePool *pool);
+void freeSparseField(sparseField *field);
+void clearSparseField(sparseField *field);
+
+void sparseSetField(long x, long y, sparseField *field);
+void sparseUnsetField(long x, long y, sparseField *field);
+int sparseGetField(long x, long y, sparseField *field);
+long sparsePopulation(sparseField *field);
+
+/*
+ * Computes the tiles nextField->active[first..last) from field. The tile set
+ * of nextField has to be prepared beforehand, see cycleSparse.
+ */
+void cycleSparseSubdomain(int first, int last, sparseField *field,
+		sparseField *nextField);
+
+/*
+ * Computes one generation from field into nextField using all threads of the
+ * enclosing OpenMP environment. Tiles of field are released afterwards, so the
+ * caller only has to swap the two fields.
+ */
+void cycleSparse(sparseField *field, sparseField *nextField);
+
+#endif /* SPARSE_H_ */
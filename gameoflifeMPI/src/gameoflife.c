@@ -1,15 +1,22 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <errno.h>
+#include <limits.h>
 #include <time.h>
 #include <mpi.h>
 #include <stdbool.h>
 
-static const int sizeX = 20;
-static const int sizeY = 20;
-static const int CHUNKS_X = 4;
-static const int RUNS_PER_THREAD = 100;
+// gameoflifeMPI <sizeX> <sizeY> [cycles] overrides these for benchmarks
+static int sizeX = 20;
+static int sizeY = 20;
+static int RUNS_PER_THREAD = 100;
 
-void writeVTK(int t, int thread, bool *field, char prefix[1024], int xleft,
+// one tag per direction, with one or two ranks both halos come from the same
+// neighbour and would otherwise be matched in the wrong order
+static const int TAG_TO_RIGHT = 1;
+static const int TAG_TO_LEFT = 2;
+
+void writeVTK(int t, int thread, bool *field, const char *prefix, int xleft,
 		int xright, int ytop, int ybottom) {
 	char name[1024] = "\0";
 	sprintf(name, "%s_%02d_%04d.vtk", prefix, thread, t);
@@ -90,9 +97,78 @@ static inline void swap_vector(bool **a, bool **b) {
 	*b = t;
 }
 
+// fills the halo: top and bottom rows locally, left and right columns from
+// the neighbour ranks
+static void exchange(bool *field, int w, int h, MPI_Comm communicator,
+		int rank_left, int rank_right, MPI_Datatype borderLeftSend,
+		MPI_Datatype borderRightSend, MPI_Datatype borderLeftRec,
+		MPI_Datatype borderRightRec) {
+	// top -> bottom
+	for (int i = 1; i < w + 1; i++) {
+		field[(h + 1) * (w + 2) + i] = field[w + 2 + i];
+	}
+
+	// bottom -> top
+	for (int i = 1; i < w + 1; i++) {
+		field[i] = field[h * (w + 2) + i];
+	}
+
+	MPI_Request requests[4];
+	MPI_Isend(field, 1, borderRightSend, rank_right, TAG_TO_RIGHT, communicator,
+			&requests[0]);
+	MPI_Isend(field, 1, borderLeftSend, rank_left, TAG_TO_LEFT, communicator,
+			&requests[1]);
+	MPI_Irecv(field, 1, borderRightRec, rank_right, TAG_TO_LEFT, communicator,
+			&requests[2]);
+	MPI_Irecv(field, 1, borderLeftRec, rank_left, TAG_TO_RIGHT, communicator,
+			&requests[3]);
+	MPI_Waitall(4, requests, MPI_STATUSES_IGNORE);
+}
+
+// deterministic soup, independent of the number of ranks
+static bool soup(int x, int y) {
+	unsigned int hash = (unsigned int) x * 2654435761u
+			^ (unsigned int) y * 2246822519u;
+	hash ^= hash >> 15;
+	hash *= 2654435761u;
+	return (hash >> 28) < 5;
+}
+
+// strtol for command line counts, fails unless text is a whole positive int
+static int parsePositive(const char *text, int *value) {
+	char *end;
+	errno = 0;
+	long parsed = strtol(text, &end, 0);
+	if (errno != 0 || *end != '\0' || end == text || parsed < 1
+			|| parsed > INT_MAX)
+		return -1;
+	*value = parsed;
+	return 0;
+}
+
 int main(int argc, char **argv) {
 	MPI_Init(&argc, &argv);
-	int dims = { CHUNKS_X };
+
+	// one chunk per rank
+	int chunksX;
+	MPI_Comm_size(MPI_COMM_WORLD, &chunksX);
+
+	// every rank needs at least one column
+	bool benchmark = argc > 1;
+	if ((benchmark && (argc > 4 || argc < 3
+			|| parsePositive(argv[1], &sizeX) != 0
+			|| parsePositive(argv[2], &sizeY) != 0
+			|| (argc > 3 && parsePositive(argv[3], &RUNS_PER_THREAD) != 0)))
+			|| sizeX < chunksX) {
+		int worldRank;
+		MPI_Comm_rank(MPI_COMM_WORLD, &worldRank);
+		if (worldRank == 0)
+			fprintf(stderr, "usage: gameoflifeMPI <sizeX> <sizeY> [cycles], "
+					"all positive, sizeX at least the number of ranks\n");
+		MPI_Finalize();
+		return EXIT_FAILURE;
+	}
+	int dims = { chunksX };
 	int periodic = { 1 };
 	MPI_Comm communicator;
 	MPI_Cart_create(MPI_COMM_WORLD, 1, &dims, &periodic, 1, &communicator);
@@ -105,9 +181,9 @@ int main(int argc, char **argv) {
 
 	int coords;
 	MPI_Cart_coords(communicator, rank, 1, &coords);
-	int xstart = coords * sizeX / CHUNKS_X;
+	int xstart = coords * sizeX / chunksX;
 	int ystart = 0;
-	int xend = xstart + sizeX / CHUNKS_X;
+	int xend = (coords + 1) * sizeX / chunksX;
 	int yend = sizeY;
 
 	printf(
@@ -148,7 +224,13 @@ int main(int argc, char **argv) {
 	bool *prev = calloc((xend - xstart + 2) * (yend - ystart + 2),
 			sizeof(bool));
 
-	if (rank == 0) {
+	if (benchmark) {
+		for (int y = 0; y < h; y++) {
+			for (int x = 0; x < w; x++) {
+				prev[INDEX(x, y, w)] = soup(xstart + x, y);
+			}
+		}
+	} else if (rank == 0) {
 		prev[1 * (w + 2) + 2] = true;
 //		prev[2 * (w + 2) + 3] = true;
 //		prev[3 * (w + 2) + 1] = true;
@@ -156,37 +238,26 @@ int main(int argc, char **argv) {
 		prev[3 * (w + 2) + 3] = true;
 	}
 
-	writeVTK(0, rank, prev, "gol", xstart, xend, ystart, yend);
+	if (!benchmark)
+		writeVTK(0, rank, prev, "gol", xstart, xend, ystart, yend);
 
+	// the first generation needs the halo of the initial board as well
+	exchange(prev, w, h, communicator, rank_left, rank_right, borderLeftSend,
+			borderRightSend, borderLeftRec, borderRightRec);
+
+	double start = MPI_Wtime();
 	for (int cycle = 1; cycle < RUNS_PER_THREAD; cycle++) {
 
 		// calculate
 		int changes = evolve(prev, field, w, h);
 
 		// output
-		writeVTK(cycle, rank, field, "gol", xstart, xend, ystart, yend);
+		if (!benchmark)
+			writeVTK(cycle, rank, field, "gol", xstart, xend, ystart, yend);
 
 		// exchange
-		// top -> bottom
-		for (int i = 1; i < w + 1; i++) {
-			field[(h + 1) * (w + 2) + i] = field[w + 2 + i];
-		}
-
-		// bottom -> top
-		for (int i = 1; i < w + 1; i++) {
-			field[i] = field[h * (w + 2) + i];
-		}
-
-		MPI_Request requests[4];
-		MPI_Isend(field, 1, borderRightSend, rank_right, 42, communicator,
-				&requests[0]);
-		MPI_Isend(field, 1, borderLeftSend, rank_left, 42, communicator,
-				&requests[1]);
-		MPI_Irecv(field, 1, borderRightRec, rank_right, 42, communicator,
-				&requests[2]);
-		MPI_Irecv(field, 1, borderLeftRec, rank_left, 42, communicator,
-				&requests[3]);
-		MPI_Waitall(4, requests, MPI_STATUSES_IGNORE);
+		exchange(field, w, h, communicator, rank_left, rank_right,
+				borderLeftSend, borderRightSend, borderLeftRec, borderRightRec);
 
 		int gathered;
 		MPI_Allreduce(&changes, &gathered, 1, MPI_INT,MPI_SUM, communicator);
@@ -197,6 +268,27 @@ int main(int argc, char **argv) {
 
 		swap_vector(&field, &prev);
 	}
+	double seconds = MPI_Wtime() - start;
+
+	// after a break both boards are equal, so prev is always the last one
+	if (benchmark) {
+		long population = 0;
+		for (int y = 0; y < h; y++) {
+			for (int x = 0; x < w; x++) {
+				population += prev[INDEX(x, y, w)];
+			}
+		}
+		long total;
+		MPI_Reduce(&population, &total, 1, MPI_LONG, MPI_SUM, 0, communicator);
+		// the slowest rank, read by scaling/scaling.py
+		double slowest;
+		MPI_Reduce(&seconds, &slowest, 1, MPI_DOUBLE, MPI_MAX, 0,
+				communicator);
+		if (rank == 0) {
+			printf("Population: %ld\n", total);
+			printf("Kernel time: %.9fs\n", slowest);
+		}
+	}
 
 	MPI_Finalize();
 	return EXIT_SUCCESS;
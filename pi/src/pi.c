@@ -1,14 +1,17 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <errno.h>
+#include <limits.h>
 #include <omp.h>
 
 #define TRYS 5000000
 
-static int throw() {
+// rand_r with a per thread seed, rand() serializes all threads on one lock
+static int throw(unsigned int *seed) {
 	double x, y;
-	x = (double) rand() / (double) RAND_MAX;
-	y = (double) rand() / (double) RAND_MAX;
+	x = (double) rand_r(seed) / (double) RAND_MAX;
+	y = (double) rand_r(seed) / (double) RAND_MAX;
 	if ((x * x + y * y) <= 1.0)
 		return 1;
 
@@ -55,26 +58,44 @@ static int throw() {
 
 // mit trefferausgabe
 int main(int argc, char **argv) {
-	int globalCount = 0, globalSamples = TRYS;
+	long globalCount = 0, globalSamples = TRYS;
 	long int thread_count = 6;
 	if (argc > 1)
 		thread_count = strtol(argv[1], NULL, 0);
 	if (thread_count < 1)
 		thread_count = 6;
+	// optional sample count, e.g. for weak scaling
+	if (argc > 2) {
+		char *end;
+		errno = 0;
+		globalSamples = strtol(argv[2], &end, 0);
+		if (errno != 0 || *end != '\0' || end == argv[2] || globalSamples < 1) {
+			fprintf(stderr, "invalid sample count %s, expected 1 to %ld\n",
+					argv[2], LONG_MAX);
+			return EXIT_FAILURE;
+		}
+	}
 	omp_set_num_threads(thread_count);
 
+	double start = omp_get_wtime();
 #pragma omp parallel reduction(+:globalCount)
 	{
-#pragma omp for
-		for (int i = 0; i < globalSamples; ++i) {
-			globalCount += throw();
+		// static schedule and a seed per thread number give the same hits
+		// for the same thread count, whatever the interleaving
+		unsigned int seed = 12345 + omp_get_thread_num();
+#pragma omp for schedule(static)
+		for (long i = 0; i < globalSamples; ++i) {
+			globalCount += throw(&seed);
 		}
-		printf("Thread %d: Trefferanzahl: %d\n", omp_get_thread_num(),
+		printf("Thread %d: Trefferanzahl: %ld\n", omp_get_thread_num(),
 				globalCount);
 	}
+	double seconds = omp_get_wtime() - start;
 	double pi = 4.0 * (double) globalCount / (double) (globalSamples);
 
 	printf("pi is %.9lf\n", pi);
+	// read by scaling/scaling.py
+	printf("Kernel time: %.9fs\n", seconds);
 
 	return 0;
 }
@@ -0,0 +1,252 @@
+#!/usr/bin/env python3
+"""Strong and weak scaling study for pi, gameoflife and gameoflifeMPI.
+
+Every program is run for a series of worker counts (OpenMP threads or MPI
+ranks). Strong scaling keeps the total problem size fixed, weak scaling keeps
+the size per worker fixed. Every program reports the time of its compute
+kernel in a "Kernel time: <seconds>s" line, which leaves out process start,
+MPI initialization and board setup. For each run the median kernel time of
+several repetitions is taken and speedup, efficiency and the Karp-Flatt
+serial fraction are derived from it:
+
+    strong:  S(p) = T(1) / T(p)
+    weak:    S(p) = p * T(1) / T(p)       (scaled speedup)
+    E(p) = S(p) / p
+    e(p) = (1 / S(p) - 1 / p) / (1 - 1 / p)
+
+Results go to scaling.csv in the output directory, plus one plot per program
+if matplotlib is available. MPI runs use a local mpirun with oversubscription,
+so rank counts above the number of cores work but are not meaningful for
+capacity planning.
+"""
+
+import argparse
+import csv
+import math
+import os
+import platform
+import re
+import shlex
+import statistics
+import subprocess
+import sys
+
+KERNEL_TIME = re.compile(r'^Kernel time: ([0-9.eE+-]+)s$', re.MULTILINE)
+
+
+def worker_counts(maximum):
+    counts = []
+    p = 1
+    while p < maximum:
+        counts.append(p)
+        p *= 2
+    counts.append(maximum)
+    return counts
+
+
+def studies(args):
+    """Command lines per program, mode and worker count.
+
+    Problem sizes are fixed so that results of different machines compare,
+    --quick shrinks them for smoke tests.
+    """
+    bin_dir = os.path.abspath(args.bin)
+    scale = 16 if args.quick else 1
+    pi = os.path.join(bin_dir, 'pi')
+    gameoflife = os.path.join(bin_dir, 'gameoflife')
+    gameoflife_mpi = os.path.join(bin_dir, 'gameoflifeMPI')
+    mpirun = shlex.split(args.mpirun)
+
+    # pi: thread count and number of samples
+    pi_samples = 20000000 // scale
+
+    def pi_command(p, samples):
+        return [pi, str(p), str(samples)]
+
+    # gameoflife: square board split into one row strip per thread
+    board = 1024 // int(math.sqrt(scale))
+    generations = 20
+
+    def gameoflife_command(p, size):
+        return [gameoflife, 'dense', str(size), '1', str(p), str(generations)]
+
+    # the area grows with p, so the side grows with sqrt(p); gameoflife rounds
+    # the side up to whole 32 bit words, do the same to report the real size
+    def weak_board(p):
+        return -(-round(board * math.sqrt(p)) // 32) * 32
+
+    # gameoflifeMPI: board split into one column strip per rank
+    mpi_width = 4096 // scale
+    mpi_height = 1024
+    cycles = 100
+
+    def mpi_command(p, width):
+        return mpirun + ['-np', str(p), gameoflife_mpi, str(width),
+                         str(mpi_height), str(cycles)]
+
+    return {
+        'pi': {
+            'workers': worker_counts(args.max_threads),
+            'strong': lambda p: (pi_samples, pi_command(p, pi_samples)),
+            'weak': lambda p: (pi_samples * p, pi_command(p, pi_samples * p)),
+        },
+        'gameoflife': {
+            'workers': worker_counts(args.max_threads),
+            'strong': lambda p: (board * board, gameoflife_command(p, board)),
+            'weak': lambda p: (weak_board(p) ** 2,
+                               gameoflife_command(p, weak_board(p))),
+        },
+        'gameoflifeMPI': {
+            'workers': worker_counts(args.max_ranks),
+            'strong': lambda p: (mpi_width * mpi_height,
+                                 mpi_command(p, mpi_width)),
+            'weak': lambda p: (mpi_width * p * mpi_height,
+                               mpi_command(p, mpi_width * p)),
+        },
+    }
+
+
+def run(command, workers, repeat, cwd):
+    env = dict(os.environ)
+    # pin threads so repeated runs see the same placement
+    env.setdefault('OMP_PROC_BIND', 'close')
+    env.setdefault('OMP_PLACES', 'cores')
+    env['OMP_NUM_THREADS'] = str(workers)
+
+    times = []
+    for _ in range(repeat):
+        result = subprocess.run(command, cwd=cwd, env=env,
+                                stdout=subprocess.PIPE,
+                                stderr=subprocess.PIPE, text=True)
+        if result.returncode != 0:
+            raise RuntimeError('%s failed with exit code %d:\n%s' % (
+                ' '.join(command), result.returncode, result.stderr))
+        match = KERNEL_TIME.search(result.stdout)
+        if match is None:
+            raise RuntimeError('%s printed no kernel time' % ' '.join(command))
+        times.append(float(match.group(1)))
+    return times
+
+
+def derive(mode, workers, median, baseline):
+    speedup = baseline / median
+    if mode == 'weak':
+        speedup *= workers
+    efficiency = speedup / workers
+    karp_flatt = None
+    if workers > 1:
+        karp_flatt = (1 / speedup - 1 / workers) / (1 - 1 / workers)
+    return speedup, efficiency, karp_flatt
+
+
+def plot(rows, out_dir):
+    try:
+        import matplotlib
+        matplotlib.use('Agg')
+        import matplotlib.pyplot as plt
+    except ImportError:
+        print('matplotlib not available, skipping plots')
+        return
+
+    for program in sorted({row['program'] for row in rows}):
+        figure, (left, right) = plt.subplots(1, 2, figsize=(10, 4))
+        for mode in ('strong', 'weak'):
+            data = [row for row in rows
+                    if row['program'] == program and row['mode'] == mode]
+            workers = [row['workers'] for row in data]
+            left.plot(workers, [row['speedup'] for row in data], 'o-',
+                      label=mode)
+            right.plot(workers, [row['efficiency'] for row in data], 'o-',
+                       label=mode)
+        if data:
+            left.plot(workers, workers, 'k--', label='ideal')
+        left.set_xlabel('workers')
+        left.set_ylabel('speedup')
+        right.set_xlabel('workers')
+        right.set_ylabel('efficiency')
+        right.set_ylim(0, 1.1)
+        left.legend()
+        right.legend()
+        figure.suptitle(program)
+        figure.tight_layout()
+        figure.savefig(os.path.join(out_dir, program + '.png'))
+        plt.close(figure)
+
+
+def main():
+    cpus = os.cpu_count() or 1
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--bin', default='build',
+                        help='directory with the built programs')
+    parser.add_argument('--out', default='build/scaling',
+                        help='directory for scaling.csv and plots')
+    parser.add_argument('--programs', nargs='+',
+                        default=['pi', 'gameoflife', 'gameoflifeMPI'])
+    parser.add_argument('--modes', nargs='+', default=['strong', 'weak'])
+    parser.add_argument('--max-threads', type=int, default=cpus)
+    parser.add_argument('--max-ranks', type=int, default=min(cpus, 8))
+    parser.add_argument('--repeat', type=int, default=3,
+                        help='runs per point, the median is reported')
+    parser.add_argument('--mpirun', default='mpirun --oversubscribe',
+                        help='launcher for gameoflifeMPI')
+    parser.add_argument('--quick', action='store_true',
+                        help='small problem sizes for smoke tests')
+    args = parser.parse_args()
+
+    os.makedirs(args.out, exist_ok=True)
+    # the programs may write output files into their working directory
+    work_dir = os.path.join(args.out, 'work')
+    os.makedirs(work_dir, exist_ok=True)
+
+    all_studies = studies(args)
+    rows = []
+    for program in args.programs:
+        study = all_studies[program]
+        for mode in args.modes:
+            baseline = None
+            for workers in study['workers']:
+                size, command = study[mode](workers)
+                times = run(command, workers, args.repeat, work_dir)
+                median = statistics.median(times)
+                if baseline is None:
+                    baseline = median
+                speedup, efficiency, karp_flatt = derive(
+                    mode, workers, median, baseline)
+                rows.append({
+                    'program': program,
+                    'mode': mode,
+                    'workers': workers,
+                    'size': size,
+                    'median_seconds': median,
+                    'min_seconds': min(times),
+                    'speedup': speedup,
+                    'efficiency': efficiency,
+                    'karp_flatt': karp_flatt,
+                })
+                print('%-14s %-6s p=%-3d %8.3fs  S=%6.2f  E=%5.2f  e=%s' % (
+                    program, mode, workers, median, speedup, efficiency,
+                    '-' if karp_flatt is None else '%.3f' % karp_flatt))
+
+    csv_path = os.path.join(args.out, 'scaling.csv')
+    with open(csv_path, 'w', newline='') as f:
+        writer = csv.DictWriter(f, fieldnames=list(rows[0].keys()))
+        writer.writeheader()
+        for row in rows:
+            writer.writerow({key: '' if value is None else value
+                             for key, value in row.items()})
+
+    with open(os.path.join(args.out, 'environment.txt'), 'w') as f:
+        f.write('host: %s\n' % platform.node())
+        f.write('platform: %s\n' % platform.platform())
+        f.write('processor: %s\n' % platform.processor())
+        f.write('cpus: %d\n' % cpus)
+        f.write('repeat: %d\n' % args.repeat)
+        f.write('quick: %s\n' % args.quick)
+
+    plot(rows, args.out)
+    print('results written to %s' % csv_path)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())